@@ -22,6 +22,26 @@ SOFTWARE.
 
 #include <iostream>
 #include <string>
+#include <array>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <cstring>
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
 extern "C" {
 #include <mpool/mpool.h>
 }
@@ -57,3 +77,225 @@ struct free_deleter {
   void operator()( T *p ) { if( p ) free( p ); }
 };
 
+
+// "0-3,8,10-11" -> { 0, 1, 2, 3, 8, 10, 11 }
+std::vector< int > parse_cpu_list( const std::string &list ) {
+  std::vector< int > cpus;
+  std::vector< bool > used( CPU_SETSIZE, false );
+  size_t head = 0u;
+  while( head < list.size() ) {
+    size_t tail = list.find( ',', head );
+    if( tail == std::string::npos ) tail = list.size();
+    const std::string range = list.substr( head, tail - head );
+    head = tail + 1u;
+    if( range.empty() ) continue;
+    try {
+      size_t dash = range.find( '-' );
+      if( range.find_first_not_of( "0123456789-" ) != std::string::npos ||
+          dash == 0u || dash + 1u == range.size() ||
+          ( dash != std::string::npos && range.find( '-', dash + 1u ) != std::string::npos ) )
+        throw std::invalid_argument( range );
+      size_t pos = 0u;
+      int begin = std::stoi( range.substr( 0, dash ), &pos );
+      if( pos != ( dash == std::string::npos ? range.size() : dash ) )
+        throw std::invalid_argument( range );
+      int end = begin;
+      if( dash != std::string::npos ) {
+        const std::string last = range.substr( dash + 1u );
+        end = std::stoi( last, &pos );
+        if( pos != last.size() ) throw std::invalid_argument( range );
+      }
+      if( begin < 0 || end < begin || end >= CPU_SETSIZE )
+        throw std::invalid_argument( range );
+      for( int cpu = begin; cpu <= end; ++cpu ) {
+        if( used[ cpu ] ) throw std::invalid_argument( range );
+        used[ cpu ] = true;
+        cpus.push_back( cpu );
+      }
+    }
+    catch( const std::logic_error& ) {
+      throw std::invalid_argument( "invalid cpu list: " + list );
+    }
+  }
+  if( cpus.empty() )
+    throw std::invalid_argument( "invalid cpu list: " + list );
+  return cpus;
+}
+
+size_t round_up_to_page( size_t size ) {
+  return ( size / PAGE_SIZE + ( size % PAGE_SIZE ? 1 : 0 ) ) * PAGE_SIZE;
+}
+
+struct munmap_deleter {
+  munmap_deleter() : size( 0u ) {}
+  explicit munmap_deleter( size_t s ) : size( s ) {}
+  void operator()( char *p ) { if( p ) munmap( p, size ); }
+  size_t size;
+};
+
+using worker_buffer = std::unique_ptr< char, munmap_deleter >;
+
+// Fresh anonymous pages are placed on the node of the thread that first
+// touches them, so this must be called after the thread is pinned.
+worker_buffer allocate_local_buffer( size_t size ) {
+  size = round_up_to_page( size );
+  void *p = mmap( nullptr, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0 );
+  if( p == MAP_FAILED ) throw std::bad_alloc();
+  worker_buffer buf( reinterpret_cast< char* >( p ), munmap_deleter( size ) );
+  memset( buf.get(), 0, size );
+  return buf;
+}
+
+struct worker_context {
+  size_t id;
+  int cpu;
+  unsigned int node;
+  size_t buffer_size;
+  std::vector< worker_buffer > buffers;
+  size_t operations;
+  size_t bytes;
+  const std::atomic< bool > *stop;
+  bool stopped() const {
+    return stop->load( std::memory_order_relaxed );
+  }
+  iovec get_iovec( size_t i ) const {
+    iovec iov;
+    iov.iov_base = buffers[ i ].get();
+    iov.iov_len = buffer_size;
+    return iov;
+  }
+};
+
+struct worker_stats {
+  size_t id;
+  int cpu;
+  unsigned int node;
+  size_t operations;
+  size_t bytes;
+  std::chrono::duration< double > elapsed;
+};
+
+struct worker_pool_stats {
+  std::vector< worker_stats > workers;
+  std::chrono::duration< double > elapsed;
+};
+
+// Runs one worker per cpu in the list. Each worker is pinned to its cpu
+// before its buffers are allocated, so the buffers live on the local node.
+// All workers are released at once after every buffer is ready, and each
+// worker's time is measured from that common start.
+// Buffers are backed by whole pages, but get_iovec reports the requested
+// size, so callers that need page-aligned lengths must round it themselves.
+class worker_pool {
+public:
+  worker_pool( const std::vector< int > &cpus_, size_t buffer_size_, size_t buffer_count_ ) :
+    cpus( cpus_ ), buffer_size( buffer_size_ ), buffer_count( buffer_count_ ) {
+    if( buffer_size == 0u ) throw std::invalid_argument( "buffer size must not be zero" );
+  }
+  worker_pool_stats run( const std::function< void( worker_context& ) > &f ) const {
+    worker_pool_stats stats;
+    stats.workers.resize( cpus.size() );
+    std::vector< std::exception_ptr > errors( cpus.size() );
+    std::atomic< bool > stop( false );
+    std::mutex guard;
+    std::condition_variable cond;
+    size_t ready = 0u;
+    bool started = false;
+    std::chrono::steady_clock::time_point begin;
+    std::vector< std::thread > threads;
+    threads.reserve( cpus.size() );
+    try {
+      for( size_t i = 0u; i != cpus.size(); ++i )
+        threads.emplace_back( [&, i]() {
+          worker_context context;
+          try {
+            setup_worker( i, context );
+          }
+          catch( ... ) {
+            errors[ i ] = std::current_exception();
+            stop = true;
+          }
+          context.stop = &stop;
+          {
+            std::unique_lock< std::mutex > lock( guard );
+            ++ready;
+            cond.notify_all();
+            cond.wait( lock, [&]() { return started; } );
+          }
+          if( errors[ i ] ) return;
+          try {
+            if( !context.stopped() ) f( context );
+          }
+          catch( ... ) {
+            errors[ i ] = std::current_exception();
+            stop = true;
+          }
+          const auto end = std::chrono::steady_clock::now();
+          stats.workers[ i ] = worker_stats{ context.id, context.cpu, context.node, context.operations, context.bytes, end - begin };
+        } );
+    }
+    catch( ... ) {
+      {
+        std::lock_guard< std::mutex > lock( guard );
+        stop = true;
+        started = true;
+        cond.notify_all();
+      }
+      for( auto &t: threads ) t.join();
+      throw;
+    }
+    {
+      std::unique_lock< std::mutex > lock( guard );
+      cond.wait( lock, [&]() { return ready == cpus.size(); } );
+      begin = std::chrono::steady_clock::now();
+      started = true;
+      cond.notify_all();
+    }
+    for( auto &t: threads ) t.join();
+    stats.elapsed = std::chrono::steady_clock::now() - begin;
+    for( auto &e: errors )
+      if( e ) std::rethrow_exception( e );
+    return stats;
+  }
+private:
+  void setup_worker( size_t id, worker_context &context ) const {
+    context.id = id;
+    context.cpu = cpus[ id ];
+    context.node = 0u;
+    context.buffer_size = buffer_size;
+    context.operations = 0u;
+    context.bytes = 0u;
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( cpus[ id ], &set );
+    int err = pthread_setaffinity_np( pthread_self(), sizeof( set ), &set );
+    if( err ) throw std::system_error( err, std::generic_category(), "pthread_setaffinity_np" );
+    unsigned int cpu = 0u;
+    if( syscall( SYS_getcpu, &cpu, &context.node, nullptr ) )
+      throw std::system_error( errno, std::generic_category(), "getcpu" );
+    for( size_t i = 0u; i != buffer_count; ++i )
+      context.buffers.push_back( allocate_local_buffer( buffer_size ) );
+  }
+  std::vector< int > cpus;
+  size_t buffer_size;
+  size_t buffer_count;
+};
+
+void print_worker_stats( std::ostream &out, const worker_pool_stats &stats ) {
+  size_t total_bytes = 0u;
+  size_t total_operations = 0u;
+  for( const auto &s: stats.workers ) {
+    const double seconds = s.elapsed.count();
+    const double mib = double( s.bytes ) / ( 1024.0 * 1024.0 );
+    const double throughput = seconds > 0.0 ? mib / seconds : 0.0;
+    total_bytes += s.bytes;
+    total_operations += s.operations;
+    out << "worker " << s.id << " cpu " << s.cpu << " node " << s.node << ": "
+      << s.operations << " ops, " << mib << " MiB in " << seconds << " s, "
+      << throughput << " MiB/s" << std::endl;
+  }
+  const double seconds = stats.elapsed.count();
+  const double mib = double( total_bytes ) / ( 1024.0 * 1024.0 );
+  out << "total: " << total_operations << " ops, " << mib << " MiB in " << seconds << " s, "
+    << ( seconds > 0.0 ? mib / seconds : 0.0 ) << " MiB/s" << std::endl;
+}
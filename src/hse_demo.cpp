@@ -82,7 +82,10 @@ int main( int argc, char* argv[] ) {
     ("delete,d", boost::program_options::bool_switch( &delete_block ),  "delete")
     ("abort,a", boost::program_options::bool_switch( &abort_transaction ),  "abort")
     ("put,P", boost::program_options::value<std::vector<std::string>>()->multitoken(),  "put")
-    ("get,g", boost::program_options::value<std::vector<std::string>>()->multitoken(),  "get");
+    ("get,g", boost::program_options::value<std::vector<std::string>>()->multitoken(),  "get")
+    ("cpus,c", boost::program_options::value<std::string>(),  "run benchmark on cpus (e.g. 0-3,8)")
+    ("iterations,i", boost::program_options::value<size_t>()->default_value( 1000 ),  "iterations per worker")
+    ("size,s", boost::program_options::value<size_t>()->default_value( 4096 ),  "value size in bytes");
   boost::program_options::variables_map params;
   boost::program_options::store( boost::program_options::parse_command_line( argc, argv, options ), params );
   boost::program_options::notify( params );
@@ -123,6 +126,45 @@ int main( int argc, char* argv[] ) {
   hse_kvs *raw_kvs;
   HSE_SAFE_CALL( hse_kvdb_kvs_open( kvdb.get(), kvs_name.c_str(), nullptr, &raw_kvs ) );
   std::shared_ptr< hse_kvs > kvs( raw_kvs, [kvdb]( hse_kvs *p ) { if( p ) hse_kvdb_kvs_close( p ); } );
+  if( params.count( "cpus" ) ) {
+    const size_t iterations = params[ "iterations" ].as< size_t >();
+    try {
+      worker_pool workers( parse_cpu_list( params[ "cpus" ].as< std::string >() ), params[ "size" ].as< size_t >(), 2u );
+      auto stats = workers.run( [&]( worker_context &worker ) {
+        iovec put_iov = worker.get_iovec( 0 );
+        iovec get_iov = worker.get_iovec( 1 );
+        hse_kvdb_opspec wos;
+        HSE_KVDB_OPSPEC_INIT( &wos );
+        std::shared_ptr< hse_kvdb_txn > worker_transaction( hse_kvdb_txn_alloc( kvdb.get() ), [kvdb]( hse_kvdb_txn *p ) { if( p ) hse_kvdb_txn_free( kvdb.get(), p ); } );
+        if( !worker_transaction ) throw std::bad_alloc();
+        wos.kop_txn = worker_transaction.get();
+        for( size_t i = 0u; i != iterations && !worker.stopped(); ++i ) {
+          const std::string key = "hse_demo." + std::to_string( worker.id ) + "." + std::to_string( i );
+          HSE_SAFE_CALL( hse_kvdb_txn_begin( kvdb.get(), wos.kop_txn ) );
+          bool finished = false;
+          std::shared_ptr< void > txn( nullptr, [&]( void* ) { if( !finished ) hse_kvdb_txn_abort( kvdb.get(), wos.kop_txn ); } );
+          HSE_SAFE_CALL( hse_kvs_put( kvs.get(), &wos, key.data(), key.size(), put_iov.iov_base, put_iov.iov_len ) );
+          bool found = false;
+          size_t length = 0;
+          HSE_SAFE_CALL( hse_kvs_get( kvs.get(), &wos, key.data(), key.size(), &found, get_iov.iov_base, get_iov.iov_len, &length ) );
+          HSE_SAFE_CALL( hse_kvs_delete( kvs.get(), &wos, key.data(), key.size() ) );
+          HSE_SAFE_CALL( hse_kvdb_txn_commit( kvdb.get(), wos.kop_txn ) );
+          finished = true;
+          worker.operations += 2u;
+          worker.bytes += put_iov.iov_len + ( found ? length : 0u );
+        }
+      } );
+      print_worker_stats( std::cout, stats );
+    }
+    catch( const mpool_error& ) {
+      return 1;
+    }
+    catch( const std::exception &e ) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
   hse_kvdb_opspec os;
   HSE_KVDB_OPSPEC_INIT( &os );
   std::shared_ptr< hse_kvdb_txn > transaction( hse_kvdb_txn_alloc( kvdb.get() ), [kvdb]( hse_kvdb_txn *p ) { if( p ) hse_kvdb_txn_free( kvdb.get(), p ); } );
@@ -41,7 +41,10 @@ int main( int argc, char* argv[] ) {
     ("message,m", boost::program_options::value< std::string >()->default_value( "Hello, World!" ), "message" )
     ("object,o", boost::program_options::value<uint64_t>(),  "object id")
     ("delete,d", boost::program_options::bool_switch( &delete_block ),  "delete")
-    ("abort,a", boost::program_options::bool_switch( &abort_transaction ),  "abort");
+    ("abort,a", boost::program_options::bool_switch( &abort_transaction ),  "abort")
+    ("cpus,c", boost::program_options::value<std::string>(),  "run benchmark on cpus (e.g. 0-3,8)")
+    ("iterations,i", boost::program_options::value<size_t>()->default_value( 1000 ),  "iterations per worker")
+    ("size,s", boost::program_options::value<size_t>()->default_value( 1024 * 1024 ),  "block size in bytes (rounded up to a page)");
   boost::program_options::variables_map params;
   boost::program_options::store( boost::program_options::parse_command_line( argc, argv, options ), params );
   boost::program_options::notify( params );
@@ -58,6 +61,47 @@ int main( int argc, char* argv[] ) {
   SAFE_CALL( mpool_open( params[ "pool" ].as< std::string >().c_str(), O_RDWR, &raw_pool, nullptr ) );
   std::shared_ptr< mpool > pool( raw_pool, []( mpool *p ) { if( p ) mpool_close( p ); } );
 
+  if( params.count( "cpus" ) ) {
+    const size_t iterations = params[ "iterations" ].as< size_t >();
+    try {
+      worker_pool workers( parse_cpu_list( params[ "cpus" ].as< std::string >() ), round_up_to_page( params[ "size" ].as< size_t >() ), 2u );
+      auto stats = workers.run( [&]( worker_context &worker ) {
+        iovec write_iov = worker.get_iovec( 0 );
+        iovec read_iov = worker.get_iovec( 1 );
+        for( size_t i = 0u; i != iterations && !worker.stopped(); ++i ) {
+          uint64_t id = 0u;
+          mblock_props p;
+          memset( reinterpret_cast< void* >( &p ), 0, sizeof( p ) );
+          SAFE_CALL( mpool_mblock_alloc( pool.get(), MP_MED_CAPACITY, false, &id, &p ) )
+          bool committed = false;
+          bool deleted = false;
+          std::shared_ptr< void > block( nullptr, [&]( void* ) {
+            if( deleted ) return;
+            if( committed ) mpool_mblock_delete( pool.get(), id );
+            else mpool_mblock_abort( pool.get(), id );
+          } );
+          SAFE_CALL( mpool_mblock_write( pool.get(), id, &write_iov, 1 ) )
+          SAFE_CALL( mpool_mblock_commit( pool.get(), id ) )
+          committed = true;
+          SAFE_CALL( mpool_mblock_read( pool.get(), id, &read_iov, 1, 0 ) )
+          SAFE_CALL( mpool_mblock_delete( pool.get(), id ) )
+          deleted = true;
+          worker.operations += 2u;
+          worker.bytes += write_iov.iov_len + read_iov.iov_len;
+        }
+      } );
+      print_worker_stats( std::cout, stats );
+    }
+    catch( const mpool_error& ) {
+      return 1;
+    }
+    catch( const std::exception &e ) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
   uint64_t block_id = 0u;
   mblock_props props;
   size_t length = 0;